@@ -0,0 +1,264 @@
+#include "Assembler.h"
+#include "CPU.h"
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+//////////////////////
+// HELPER FUNCTIONS //
+// Splits a line into mnemonic and operands: "sw x5, -2(x29)" -> sw x5 -2(x29)
+vector<string> tokenize(const string& line) {
+	vector<string> tokens;
+	string token;
+	for (size_t i = 0; i < line.size(); i++) {
+		char c = line[i];
+		if (isspace((unsigned char)c) || c == ',') {
+			if (!token.empty()) {
+				tokens.push_back(token);
+				token.clear();
+			}
+		} else {
+			token += c;
+		}
+	}
+	if (!token.empty()) {
+		tokens.push_back(token);
+	}
+	return tokens;
+}
+// Labels are identifiers: a letter, '_' or '.', then letters, digits, '_' or '.'
+bool isIdentifier(const string& token) {
+	if (token.empty() || isdigit((unsigned char)token[0])) {
+		return false;
+	}
+	for (size_t i = 0; i < token.size(); i++) {
+		char c = token[i];
+		if (!isalnum((unsigned char)c) && c != '_' && c != '.') {
+			return false;
+		}
+	}
+	return true;
+}
+// Result annotations such as "(a0,a1) = (-10,-10)" trail the shipped listings
+bool isAnnotation(const string& code) {
+	const string prefix = "(a0,a1)";
+	size_t start = code.find_first_not_of(" \t\r");
+	if (start == string::npos || code.compare(start, prefix.size(), prefix) != 0) {
+		return false;
+	}
+	size_t next = code.find_first_not_of(" \t", start + prefix.size());
+	return next != string::npos && code[next] == '=';
+}
+// Parses a decimal number, or hex with a 0x prefix, with an optional sign
+bool parseNumber(const string& token, long& value) {
+	size_t i = 0;
+	if (i < token.size() && (token[i] == '+' || token[i] == '-')) {
+		i++;
+	}
+	int base = 10;
+	if (token.compare(i, 2, "0x") == 0 || token.compare(i, 2, "0X") == 0) {
+		base = 16;
+		i += 2;
+	}
+	string digits = token.substr(i);
+	if (digits.empty() || !isxdigit((unsigned char)digits[0])) {
+		return false;
+	}
+	char* end;
+	value = strtol(digits.c_str(), &end, base);
+	if (*end != '\0') {
+		return false;
+	}
+	if (token[0] == '-') {
+		value = -value;
+	}
+	return true;
+}
+bitset<32> rType(unsigned long funct7, unsigned long rs2, unsigned long rs1, unsigned long funct3, unsigned long rd, bitset<7> opcode) {
+	return bitset<32>(funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode.to_ulong());
+}
+bitset<32> iType(long imm, unsigned long rs1, unsigned long funct3, unsigned long rd, bitset<7> opcode) {
+	return bitset<32>((imm & 0xFFF) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode.to_ulong());
+}
+bitset<32> sType(long imm, unsigned long rs2, unsigned long rs1, unsigned long funct3) {
+	return bitset<32>(((imm >> 5) & 0x7F) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | (imm & 0x1F) << 7 | OPCODE_STORE.to_ulong());
+}
+bitset<32> bType(long imm, unsigned long rs2, unsigned long rs1, unsigned long funct3) {
+	return bitset<32>(((imm >> 12) & 0x1) << 31 | ((imm >> 5) & 0x3F) << 25 | rs2 << 20 | rs1 << 15 |
+					  funct3 << 12 | ((imm >> 1) & 0xF) << 8 | ((imm >> 11) & 0x1) << 7 | OPCODE_BRANCH.to_ulong());
+}
+bitset<32> jType(long imm, unsigned long rd) {
+	return bitset<32>(((imm >> 20) & 0x1) << 31 | ((imm >> 1) & 0x3FF) << 21 | ((imm >> 11) & 0x1) << 20 |
+					  ((imm >> 12) & 0xFF) << 12 | rd << 7 | OPCODE_J.to_ulong());
+}
+
+
+/////////////////////
+// ASSEMBLER CLASS //
+// Strips the comment and any leading "label:" definitions, returning the labels found
+string Assembler::stripLine(const string& line, vector<string>& lineLabels) {
+	string code = line.substr(0, line.find('#'));
+	size_t colon;
+	while ((colon = code.find(':')) != string::npos) {
+		vector<string> label = tokenize(code.substr(0, colon));
+		if (label.size() != 1 || !isIdentifier(label[0])) {
+			error("invalid label: " + code.substr(0, colon + 1));
+		}
+		lineLabels.push_back(label[0]);
+		code = code.substr(colon + 1);
+	}
+	return code;
+}
+vector<bitset<32> > Assembler::assemble(istream& in) {
+	vector<string> lines;
+	string line;
+	while (getline(in, line)) {
+		lines.push_back(line);
+	}
+
+	// First pass: label addresses
+	labels.clear();
+	unsigned long address = 0;
+	for (lineNum = 1; lineNum <= (int)lines.size(); lineNum++) {
+		vector<string> lineLabels;
+		string code = stripLine(lines[lineNum - 1], lineLabels);
+		for (size_t i = 0; i < lineLabels.size(); i++) {
+			if (labels.count(lineLabels[i])) {
+				error("duplicate label: " + lineLabels[i]);
+			}
+			labels[lineLabels[i]] = address;
+		}
+		if (!isAnnotation(code) && !tokenize(code).empty()) {
+			address += 4;
+		}
+	}
+
+	// Second pass: encode
+	vector<bitset<32> > program;
+	address = 0;
+	for (lineNum = 1; lineNum <= (int)lines.size(); lineNum++) {
+		vector<string> lineLabels;
+		string code = stripLine(lines[lineNum - 1], lineLabels);
+		if (isAnnotation(code)) {
+			continue;
+		}
+		vector<string> tokens = tokenize(code);
+		if (tokens.empty()) {
+			continue;
+		}
+		program.push_back(encode(tokens, address));
+		address += 4;
+	}
+	return program;
+}
+vector<bitset<32> > Assembler::assembleFile(const string& fileName) {
+	ifstream infile(fileName);
+	if (!(infile.is_open() && infile.good())) {
+		cerr << "error opening file: " << fileName << endl;
+		exit(1);
+	}
+	return assemble(infile);
+}
+bitset<32> Assembler::encode(const vector<string>& tokens, unsigned long address) {
+	string op = tokens[0];
+	for (size_t i = 0; i < op.size(); i++) {
+		op[i] = tolower((unsigned char)op[i]);
+	}
+
+	unsigned long expected = 0;
+	if (op == "lui" || op == "jal" || op == "lb" || op == "lw" || op == "sb" || op == "sw") {
+		expected = 3;
+	} else if (op == "add" || op == "xor" || op == "ori" || op == "srai" || op == "beq") {
+		expected = 4;
+	} else {
+		error("unsupported instruction: " + tokens[0]);
+	}
+	if (tokens.size() != expected) {
+		error("wrong number of operands for " + op);
+	}
+
+	if (op == "add") {		// add rd, rs1, rs2
+		return rType(0x00, parseRegister(tokens[3]), parseRegister(tokens[2]), 0x0, parseRegister(tokens[1]), OPCODE_R_TYPE);
+	}
+	else if (op == "xor") {	// xor rd, rs1, rs2
+		return rType(0x00, parseRegister(tokens[3]), parseRegister(tokens[2]), 0x4, parseRegister(tokens[1]), OPCODE_R_TYPE);
+	}
+	else if (op == "ori") {	// ori rd, rs1, imm
+		return iType(parseImmediate(tokens[3], -2048, 2047), parseRegister(tokens[2]), 0x6, parseRegister(tokens[1]), OPCODE_I_TYPE);
+	}
+	else if (op == "srai") {	// srai rd, rs1, shamt
+		return rType(0x20, parseImmediate(tokens[3], 0, 31), parseRegister(tokens[2]), 0x5, parseRegister(tokens[1]), OPCODE_I_TYPE);
+	}
+	else if (op == "lui") {	// lui rd, imm
+		long imm = parseImmediate(tokens[2], 0, 0xFFFFF);
+		return bitset<32>((imm & 0xFFFFF) << 12 | parseRegister(tokens[1]) << 7 | OPCODE_LUI.to_ulong());
+	}
+	else if (op == "lb" || op == "lw") {	// lw rd, imm(rs1)
+		long imm;
+		unsigned long rs1;
+		parseMemOperand(tokens[2], imm, rs1);
+		return iType(imm, rs1, op == "lb" ? 0x0 : 0x2, parseRegister(tokens[1]), OPCODE_LOAD);
+	}
+	else if (op == "sb" || op == "sw") {	// sw rs2, imm(rs1)
+		long imm;
+		unsigned long rs1;
+		parseMemOperand(tokens[2], imm, rs1);
+		return sType(imm, parseRegister(tokens[1]), rs1, op == "sb" ? 0x0 : 0x2);
+	}
+	else if (op == "beq") {	// beq rs1, rs2, target
+		return bType(parseTarget(tokens[3], address, -4096, 4094), parseRegister(tokens[2]), parseRegister(tokens[1]), 0x0);
+	}
+	else {					// jal rd, target
+		return jType(parseTarget(tokens[2], address, -1048576, 1048574), parseRegister(tokens[1]));
+	}
+}
+unsigned long Assembler::parseRegister(const string& token) {
+	if (token.size() >= 2 && (token[0] == 'x' || token[0] == 'X')) {
+		char* end;
+		long regNum = strtol(token.c_str() + 1, &end, 10);
+		if (*end == '\0' && regNum >= 0 && regNum < 32) {
+			return regNum;
+		}
+	}
+	error("invalid register: " + token);
+	return 0;
+}
+long Assembler::parseImmediate(const string& token, long minValue, long maxValue) {
+	long value;
+	if (!parseNumber(token, value)) {
+		error("invalid immediate: " + token);
+	}
+	if (value < minValue || value > maxValue) {
+		error("immediate out of range: " + token);
+	}
+	return value;
+}
+void Assembler::parseMemOperand(const string& token, long& imm, unsigned long& rs1) {
+	// Exactly "imm(rs1)"
+	size_t open = token.find('(');
+	if (open == string::npos || open == 0 || token[token.size() - 1] != ')') {
+		error("expected imm(register): " + token);
+	}
+	imm = parseImmediate(token.substr(0, open), -2048, 2047);
+	rs1 = parseRegister(token.substr(open + 1, token.size() - open - 2));
+}
+long Assembler::parseTarget(const string& token, unsigned long address, long minValue, long maxValue) {
+	long offset;
+	if (labels.count(token)) {
+		offset = (long)labels[token] - (long)address;
+	} else {
+		long value;
+		if (!parseNumber(token, value)) {
+			error("undefined label: " + token);
+		}
+		offset = parseImmediate(token, minValue, maxValue);
+	}
+	if (offset < minValue || offset > maxValue || offset % 2 != 0) {
+		error("branch target out of range: " + token);
+	}
+	return offset;
+}
+void Assembler::error(const string& message) {
+	cerr << "Assembler error on line " << lineNum << ": " << message << endl;
+	exit(1);
+}
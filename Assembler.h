@@ -0,0 +1,30 @@
+#include <bitset>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+// Assembles the RISC-V subset handled by ControlUnit:
+//   add, xor, ori, srai, lui, lb, lw, sb, sw, beq, jal
+// Supports '#' comments and "label:" definitions. Branch/jump targets may be
+// a label or a byte offset relative to the instruction (as in *-instr.txt).
+// The result is the encoded instruction words, which the CPU fetches directly.
+class Assembler {
+public:
+	vector<bitset<32> > assemble(istream& in);
+	vector<bitset<32> > assembleFile(const string& fileName);
+
+private:
+	string stripLine(const string& line, vector<string>& lineLabels);
+	bitset<32> encode(const vector<string>& tokens, unsigned long address);
+	unsigned long parseRegister(const string& token);
+	long parseImmediate(const string& token, long minValue, long maxValue);
+	void parseMemOperand(const string& token, long& imm, unsigned long& rs1);
+	long parseTarget(const string& token, unsigned long address, long minValue, long maxValue);
+	void error(const string& message);
+
+	map<string, unsigned long> labels;
+	int lineNum;
+};
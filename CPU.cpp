@@ -139,19 +139,19 @@ bitset<7> Instruction::getFunct7() const {
 // CPU CLASS //
 CPU::CPU(char imem[4096])
 {
-	// Data memory
-	for (int i = 0; i < 4096; i++) {
-		dmemory[i] = bitset<8>(0);
-	}
+	// Data memory (every page starts out sharing one zero page)
+	shared_ptr<MemPage> zeroPage = make_shared<MemPage>();
+	dmemory.assign(DMEM_NUM_PAGES, zeroPage);
+	dirty.reset();
 
 	// Instruction memory
-	for (int i = 0; i < 4096; i++) {
-		imemory[i] = imem[i];
+	if (imem != NULL) {
+		imemory = make_shared<const vector<char> >(imem, imem + 4096);
 	}
 
 	// Registers
 	for (int i = 0; i < 32; i++) {
-		registers.push_back(bitset<32>(0));
+		registers[i] = bitset<32>(0);
 	}
 
 	PC = 0;
@@ -163,6 +163,42 @@ CPU::CPU(char imem[4096])
 	aluResult = bitset<32>(0);
 	dataMemValue = bitset<32>(0);
 }
+CPU::CPU(const vector<bitset<32> >& instructions) : CPU(NULL)
+{
+	program = make_shared<const vector<bitset<32> > >(instructions);
+}
+CPU CPU::fork() {
+	// Pages, registers and PC are plain value copies; page contents stay shared
+	dirty.reset();
+	CPU child = *this;
+	return child;
+}
+bitset<8> CPU::readMemory(unsigned long address) const {
+	checkAddress(address);
+	return dmemory[address / DMEM_PAGE_SIZE]->bytes[address % DMEM_PAGE_SIZE];
+}
+void CPU::writeMemory(unsigned long address, bitset<8> value) {
+	checkAddress(address);
+	shared_ptr<MemPage>& page = dmemory[address / DMEM_PAGE_SIZE];
+	if (page.use_count() > 1) { // shared with another CPU (or the zero page), copy before writing
+		page = make_shared<MemPage>(*page);
+	}
+	page->bytes[address % DMEM_PAGE_SIZE] = value;
+	dirty[address / DMEM_PAGE_SIZE] = 1;
+}
+void CPU::checkAddress(unsigned long address) const {
+	// Negative effective addresses wrap to large unsigned values and land here too
+	if (address >= DMEM_SIZE) {
+		cerr << "Invalid data memory address: " << address << endl;
+		exit(1);
+	}
+}
+bitset<DMEM_NUM_PAGES> CPU::dirtyPages() const {
+	return dirty;
+}
+void CPU::clearDirty() {
+	dirty.reset();
+}
 unsigned long CPU::readPC() {
 	return PC;
 }
@@ -180,10 +216,17 @@ void CPU::writeRegister(int regNum, bitset<32> value) {
 	registers[regNum] = value;
 }
 bitset<32> CPU::instructionFetch() {
+	if (program) {
+		// PC counts hex characters, 8 per instruction; past the end is a no-op
+		unsigned long index = readPC() / 8;
+		setPC(readPC() + 8);
+		return index < program->size() ? (*program)[index] : bitset<32>(0);
+	}
+
 	char hex[9];
 	for (int i = 7; i >= 0; i-=2) {
-        hex[i-1] = imemory[readPC()];
-		hex[i] = imemory[readPC()+1];
+        hex[i-1] = (*imemory)[readPC()];
+		hex[i] = (*imemory)[readPC()+1];
 		incPC();
 		incPC();
     }
@@ -293,13 +336,13 @@ void CPU::memory() {
 			//cout << "value (binary): " << rs2Value << endl;
             for (int i = 3; i >= 0; --i) {
 				//cout << "Writing to address: " << address + i << " value (binary): " << bitset<8>((rs2Value.to_ulong() >> (i * 8)) & 0xFF) << endl;
-                dmemory[address + i] = (rs2Value.to_ulong() >> (i * 8)) & 0xFF;
+                writeMemory(address + i, (rs2Value.to_ulong() >> (i * 8)) & 0xFF);
             }
         } else if (control.memSize == 0) { // SB
 			//cout << "Store byte" << endl;
 			//cout << "value (binary): " << rs2Value << endl;
 			//cout << "Writing to address: " << address << " byte (decimal): " << (rs2Value.to_ulong() & 0xFF) << " byte (binary): " << bitset<8>(rs2Value.to_ulong() & 0xFF) << endl;
-            dmemory[address] = rs2Value.to_ulong() & 0xFF;
+            writeMemory(address, rs2Value.to_ulong() & 0xFF);
 			//cout << dmemory[address] << endl;
         }
     }
@@ -308,16 +351,16 @@ void CPU::memory() {
 		if (control.memSize == 1) { // LW
 			//cout << "Load word" << endl;
 			for (int i = 0; i < 4; ++i) {
-				//cout << "Reading from address: " << address + i << " value: " << dmemory[address + i].to_ulong() << endl;
-				dataMemValue |= (dmemory[address + i].to_ulong() & 0xFF) << (i * 8);
+				//cout << "Reading from address: " << address + i << " value: " << readMemory(address + i).to_ulong() << endl;
+				dataMemValue |= (readMemory(address + i).to_ulong() & 0xFF) << (i * 8);
 				//cout << dataMemValue << endl;
 			}
 			//cout << bitsetToSignedInt(dataMemValue) << endl;
 		}
 		else if (control.memSize == 0) { // LB
 			//cout << "Load byte" << endl;
-			//cout << "Reading from address: " << address << " value: " << dmemory[address].to_ulong() << endl;
-			unsigned char byteValue = dmemory[address].to_ulong() & 0xFF;
+			//cout << "Reading from address: " << address << " value: " << readMemory(address).to_ulong() << endl;
+			unsigned char byteValue = readMemory(address).to_ulong() & 0xFF;
 			// Sign extension
 			if (byteValue & 0x80) {
 				dataMemValue = bitset<32>(byteValue | 0xFFFFFF00);
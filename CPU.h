@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <tuple>
+#include <memory>
 using namespace std;
 
 
@@ -25,6 +26,10 @@ const bitset<4> ALU_OP_OR(0x1);      	// 0001: OR
 const bitset<4> ALU_OP_LUI(0x7);     	// 0111: LUI
 const bitset<4> ALU_OP_SRAI(0x5);    	// 0101: SRAI
 const bitset<4> ALU_OP_DEFAULT(0x8); 	// 1000: Default
+// Data memory
+const int DMEM_SIZE = 4096;				// 4KB
+const int DMEM_PAGE_SIZE = 256;			// bytes per copy-on-write page
+const int DMEM_NUM_PAGES = DMEM_SIZE / DMEM_PAGE_SIZE;
 
 
 class ControlUnit {
@@ -73,9 +78,20 @@ public:
 };
 
 
+struct MemPage {
+	bitset<8> bytes[DMEM_PAGE_SIZE];
+};
+
+
 class CPU {
 public:
 	CPU(char imem[4096]);
+	CPU(const vector<bitset<32> >& instructions); // encoded instruction words, e.g. from Assembler
+	CPU fork(); // copy that shares memory pages until either side writes; clears both dirty bitmaps
+	bitset<8> readMemory(unsigned long address) const;
+	void writeMemory(unsigned long address, bitset<8> value);
+	bitset<DMEM_NUM_PAGES> dirtyPages() const; // pages this CPU wrote since construction/fork/clearDirty
+	void clearDirty();
 	unsigned long readPC();
 	void incPC();
 	void setPC(unsigned long newPC);
@@ -89,10 +105,12 @@ public:
 	void writeBack();
 
 private:
-	bitset<8> dmemory[4096]; 
-	char imemory[4096]; 
+	vector<shared_ptr<MemPage> > dmemory; // copy-on-write pages
+	bitset<DMEM_NUM_PAGES> dirty;
+	shared_ptr<const vector<char> > imemory; // read-only, shared between forks
+	shared_ptr<const vector<bitset<32> > > program; // encoded instruction words, fetched instead of imemory when set
 	unsigned long PC;
-	vector<bitset<32> > registers;
+	bitset<32> registers[32];
 
 	ControlUnit control;
 	bitset<32> rs1Value;
@@ -101,4 +119,6 @@ private:
 	bitset<32> immValue;
 	bitset<32> aluResult;
 	bitset<32> dataMemValue;
+
+	void checkAddress(unsigned long address) const;
 };
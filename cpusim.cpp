@@ -1,4 +1,5 @@
 #include "CPU.h"
+#include "Assembler.h"
 
 #include <iostream>
 #include <bitset>
@@ -8,6 +9,7 @@
 #include <fstream>
 #include <sstream>
 #include <tuple>
+#include <cctype>
 using namespace std;
 
 /*
@@ -17,6 +19,35 @@ Add all the required standard and developed libraries here
 /*
 Put/Define any helper function/definitions you need here
 */
+const unsigned long NO_FORK = (unsigned long)-1;
+
+// Runs the processor's main loop until the program ends (PC reaches maxPC)
+// or PC reaches stopPC before fetching. Returns true if it stopped at stopPC.
+bool run(CPU& cpu, unsigned long maxPC, unsigned long stopPC) {
+	while (true) { // Each iteration is equal to one clock cycle.
+		if (cpu.readPC() == stopPC)
+			return true;
+
+		Instruction instr = Instruction(cpu.instructionFetch()); 
+	
+		cpu.instructionDecode(instr);
+
+		cpu.executeInstruction();
+
+		cpu.memory();
+
+		cpu.writeBack();
+
+		if (cpu.readPC() >= maxPC)
+			return false;
+	}
+}
+void printResult(CPU& cpu) {
+	int a0 = cpu.readRegister(10).to_ulong();
+	int a1 = cpu.readRegister(11).to_ulong();  
+
+	cout << "(" << a0 << "," << a1 << ")";
+}
 int main(int argc, char* argv[]) {
 	/* This is the front end of your project.
 	You need to first read the instructions that are stored in a file and load them into an instruction memory.
@@ -27,6 +58,7 @@ int main(int argc, char* argv[]) {
 	*/
 
 	char instMem[4096];
+	int maxPC;
 
 
 	if (argc < 2) {
@@ -34,59 +66,98 @@ int main(int argc, char* argv[]) {
 		return -1;
 	}
 
-	ifstream infile(argv[1]); //open the file
-	if (!(infile.is_open() && infile.good())) {
-		cout<<"error opening file\n";
-		return 0; 
+	// Options (before the file name):
+	//   -a           the file is an assembly listing (e.g. loop-instr.txt), assembled in-process
+	//   -f <addr>    fork the CPU before the instruction at byte address <addr> (decimal, multiple of 4) first executes,
+	//                run the parent and then the child to the end, and print both results
+	bool assembleSource = false;
+	unsigned long forkPC = NO_FORK;
+	int argi = 1;
+	while (argi < argc - 1 && argv[argi][0] == '-') {
+		string option = argv[argi];
+		if (option == "-a") {
+			assembleSource = true;
+		}
+		else if (option == "-f" && argi + 1 < argc - 1) {
+			string address = argv[++argi];
+			char* end;
+			unsigned long forkAddress = strtoul(address.c_str(), &end, 10);
+			if (!isdigit((unsigned char)address[0]) || *end != '\0' || forkAddress % 4 != 0) {
+				cerr << "Invalid fork address: " << address << endl;
+				return -1;
+			}
+			forkPC = forkAddress * 2; // PC counts hex characters
+		}
+		else {
+			cerr << "Invalid option: " << option << endl;
+			return -1;
+		}
+		argi++;
+	}
+	string fileName = argv[argi];
+
+	vector<bitset<32> > program;
+	if (assembleSource) {
+		program = Assembler().assembleFile(fileName);
 	}
-	string line; 
-	int i = 0;
-	while (infile) {
-			infile>>line;
-			stringstream line2(line);
-			char x; 
-			line2>>x;
-			instMem[i] = x; // be careful about hex
-			i++;
-			line2>>x;
-			instMem[i] = x; // be careful about hex
-			//cout<<instMem[i-1]<< instMem[i] <<endl; // prints instruction
-			i++;
+	else {
+		ifstream infile(fileName); //open the file
+		if (!(infile.is_open() && infile.good())) {
+			cout<<"error opening file\n";
+			return 0; 
 		}
+		string line; 
+		int i = 0;
+		while (infile) {
+				infile>>line;
+				stringstream line2(line);
+				char x; 
+				line2>>x;
+				instMem[i] = x; // be careful about hex
+				i++;
+				line2>>x;
+				instMem[i] = x; // be careful about hex
+				//cout<<instMem[i-1]<< instMem[i] <<endl; // prints instruction
+				i++;
+			}
 	
-	int maxPC= i-2; // THIS IS PROBABLY WRONG
+		maxPC= i-2; // THIS IS PROBABLY WRONG
+	}
 
 	/* Instantiate your CPU object here.  CPU class is the main class in this project that defines different components of the processor.
 	CPU class also has different functions for each stage (e.g., fetching an instruction, decoding, etc.).
 	*/
 	
 	// call the approriate constructor here to initialize the processor... 
-	CPU cpu = CPU(instMem); 
+	CPU cpu = assembleSource ? CPU(program) : CPU(instMem); 
+	if (assembleSource) {
+		maxPC = program.size() * 8; // PC counts hex characters
+	}
 	// make sure to create a variable for PC and resets it to zero (e.g., unsigned int PC = 0); 
 	cpu.setPC(0);
 	
-	bool done = true;
-	while (done == true) { // processor's main loop. Each iteration is equal to one clock cycle.  
-
-		Instruction instr = Instruction(cpu.instructionFetch()); 
-	
-		cpu.instructionDecode(instr);
-
-		cpu.executeInstruction();
-
-		cpu.memory();
-
-		cpu.writeBack();
-
-		if (cpu.readPC() >= maxPC)
-			break;
-
+	if (run(cpu, maxPC, forkPC)) {
+		// Forked state shares data memory pages until one side writes to them
+		CPU child = cpu.fork();
+		run(cpu, maxPC, NO_FORK);
+		run(child, maxPC, NO_FORK);
+
+		cout << "parent: ";
+		printResult(cpu);
+		cout << " dirty pages: " << cpu.dirtyPages() << endl;
+		cout << "child:  ";
+		printResult(child);
+		cout << " dirty pages: " << child.dirtyPages() << endl;
+		return 0;
+	}
+	if (forkPC != NO_FORK) {
+		cerr << "Fork address never reached" << endl;
+		return 1;
 	}
-	int a0 = cpu.readRegister(10).to_ulong();
-	int a1 = cpu.readRegister(11).to_ulong();  
 
 	// print the results (you should replace a0 and a1 with your own variables that point to a0 and a1)
-	  cout << "(" << a0 << "," << a1 << ")" << endl;
+	printResult(cpu);
+	cout << endl;
 	
 	return 0;
 